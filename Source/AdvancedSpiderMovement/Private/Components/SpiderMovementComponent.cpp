@@ -2,36 +2,598 @@
 
 
 #include "Components/SpiderMovementComponent.h"
-#include "Kismet/KismetSystemLibrary.h"
 #include "Utilities/TraceUtils.h"
 #include "Debug/DebugHelper.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "GameFramework/PhysicsVolume.h"
+#include "GameFramework/MovementComponent.h"
+#include "Subsystems/SpiderHibernationSubsystem.h"
+
+DECLARE_STATS_GROUP(TEXT("SpiderMovement"), STATGROUP_SpiderMovement, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Scene Queries"), STAT_SpiderSceneQueries, STATGROUP_SpiderMovement);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sweeps Performed"), STAT_SpiderSweepsPerformed, STATGROUP_SpiderMovement);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sweeps Elided"), STAT_SpiderSweepsElided, STATGROUP_SpiderMovement);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Landing Predictions"), STAT_SpiderLandingPredictions, STATGROUP_SpiderMovement);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Base Contact Reuses"), STAT_SpiderBaseContactReuses, STATGROUP_SpiderMovement);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Probe Cascade Exit: Cached Open Space"), STAT_SpiderCascadeCached, STATGROUP_SpiderMovement);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Probe Cascade Exit: Overlap Clear"), STAT_SpiderCascadeOverlapClear, STATGROUP_SpiderMovement);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Probe Cascade Exit: Capsule Sweep"), STAT_SpiderCascadeCapsuleSweep, STATGROUP_SpiderMovement);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Probe Cascade Walking: Cheap Exit"), STAT_SpiderCascadeWalkingCheap, STATGROUP_SpiderMovement);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Probe Cascade Walking: Capsule Sweep"), STAT_SpiderCascadeWalkingSweep, STATGROUP_SpiderMovement);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Sleeping Spiders"), STAT_SpiderSleeping, STATGROUP_SpiderMovement);
+
+static TAutoConsoleVariable<bool> CVarSpiderProbeForceCapsuleSweep(
+	TEXT("Spider.Probe.ForceCapsuleSweep"),
+	false,
+	TEXT("Always run the surface capsule sweep, bypassing the cheaper cascade stages. Used to compare against the cascade."));
+
+void FSpiderPackedNormal::Pack(const FVector& Normal)
+{
+	X = static_cast<int16>(FMath::RoundToInt(FMath::Clamp(Normal.X, -1.0, 1.0) * MAX_int16));
+	Y = static_cast<int16>(FMath::RoundToInt(FMath::Clamp(Normal.Y, -1.0, 1.0) * MAX_int16));
+	Z = static_cast<int16>(FMath::RoundToInt(FMath::Clamp(Normal.Z, -1.0, 1.0) * MAX_int16));
+}
+
+FVector FSpiderPackedNormal::Unpack() const
+{
+	return FVector(X, Y, Z).GetSafeNormal();
+}
+
+void FSpiderMovementApplyTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	FActorComponentTickFunction::ExecuteTickHelper(Target, /*bTickInEditor=*/ false, DeltaTime, TickType, [this, TickType](float DilatedTime)
+	{
+		Target->ApplyPendingMovement(DilatedTime, TickType);
+	});
+}
+
+FString FSpiderMovementApplyTickFunction::DiagnosticMessage()
+{
+	return Target->GetFullName() + TEXT("[USpiderMovementComponent::ApplyPendingMovement]");
+}
+
+FName FSpiderMovementApplyTickFunction::DiagnosticContext(bool bDetailed)
+{
+	if (bDetailed)
+	{
+		return FName(*FString::Printf(TEXT("SpiderMovementApply/%s"), *GetFullNameSafe(Target)));
+	}
+	return FName(TEXT("SpiderMovementApply"));
+}
+
+USpiderMovementComponent::USpiderMovementComponent()
+{
+	// Probe and solve, thread affinity is decided on registration from bTickProbeOnAnyThread
+	PrimaryComponentTick.TickGroup = TG_PrePhysics;
+
+	// Apply, always on the game thread right after the probe
+	ApplyTickFunction.bCanEverTick = true;
+	ApplyTickFunction.bStartWithTickEnabled = true;
+	ApplyTickFunction.bRunOnAnyThread = false;
+	ApplyTickFunction.TickGroup = TG_PrePhysics;
+}
+
+void USpiderMovementComponent::SetUpdatedComponent(USceneComponent* NewUpdatedComponent)
+{
+	Super::SetUpdatedComponent(NewUpdatedComponent);
+
+	// Physics volume is refreshed by UpdatePhysicsVolumeIfNeeded instead of on every move
+	if (UpdatedComponent)
+	{
+		UpdatedComponent->SetShouldUpdatePhysicsVolume(false);
+		LastPhysicsVolumeUpdateLocation = UpdatedComponent->GetComponentLocation();
+		bHasNearbyPhysicsVolumeBounds = false;
+	}
+}
+
+void USpiderMovementComponent::SetComponentTickEnabled(bool bEnabled)
+{
+	Super::SetComponentTickEnabled(bEnabled);
+	ApplyTickFunction.SetTickFunctionEnable(bEnabled);
+}
+
+void USpiderMovementComponent::RegisterComponentTickFunctions(bool bRegister)
+{
+	// Debug drawing is only allowed on the game thread
+	PrimaryComponentTick.bRunOnAnyThread = bTickProbeOnAnyThread && !bDrawDebug;
+
+	Super::RegisterComponentTickFunctions(bRegister);
+
+	if (bRegister)
+	{
+		// Registration re-enables ticks that start enabled, a sleeping or hibernating spider has to stay suspended
+		if (bIsSleeping || bIsHibernating)
+		{
+			PrimaryComponentTick.SetTickFunctionEnable(false);
+		}
+
+		if (SetupActorComponentTickFunction(&ApplyTickFunction))
+		{
+			ApplyTickFunction.Target = this;
+			ApplyTickFunction.AddPrerequisite(this, PrimaryComponentTick);
+
+			// The apply phase only has work when the probe phase ran
+			ApplyTickFunction.SetTickFunctionEnable(PrimaryComponentTick.IsTickFunctionEnabled());
+		}
+	}
+	else if (ApplyTickFunction.IsTickFunctionRegistered())
+	{
+		ApplyTickFunction.UnRegisterTickFunction();
+	}
+}
+
+void USpiderMovementComponent::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	// Non reflected allocations are invisible to the serializer based counters
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(SurfaceComponents.GetAllocatedSize());
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(NearbyPhysicsVolumeBounds.GetAllocatedSize());
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(TickPrerequisiteBaseComponents.GetAllocatedSize());
+	if (DebugHitResults)
+	{
+		CumulativeResourceSize.AddDedicatedSystemMemoryBytes(sizeof(FSpiderDebugHitResults) + DebugHitResults->SpiderSurfaceTracedResults.GetAllocatedSize());
+	}
+}
+
+void USpiderMovementComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Built once so the probe phase never converts object types or resolves the world per trace
+	SurfaceObjectQueryParams = UTraceUtils::MakeObjectQueryParams(SpiderSurfaceTraceTypes);
+	SurfaceQueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(SpiderSurfaceTrace), false, GetOwner());
+	TakeProbeSnapshot();
+
+	// The open space overlap has to stay clear of the ground the spider rests on, or walking always ends in the capsule sweep
+	if (bProbeForWalls && UpdatedPrimitive && GetSurfaceProbeBoundingRadius() >= UpdatedPrimitive->GetCollisionShape().GetExtent().Z)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s: surface probe reaches %.1f from the center but the collision only %.1f, the probe cascade will always sweep on the ground"),
+			*GetFullName(), GetSurfaceProbeBoundingRadius(), UpdatedPrimitive->GetCollisionShape().GetExtent().Z);
+	}
+
+	if (bAllowHibernation)
+	{
+		if (USpiderHibernationSubsystem* HibernationSubsystem = GetWorld()->GetSubsystem<USpiderHibernationSubsystem>())
+		{
+			HibernationSubsystem->RegisterSpider(this);
+		}
+	}
+}
+
+void USpiderMovementComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (bIsSleeping)
+	{
+		UnbindWakeEvents();
+		bIsSleeping = false;
+		DEC_DWORD_STAT(STAT_SpiderSleeping);
+	}
+
+	if (bAllowHibernation)
+	{
+		if (USpiderHibernationSubsystem* HibernationSubsystem = GetWorld()->GetSubsystem<USpiderHibernationSubsystem>())
+		{
+			HibernationSubsystem->UnregisterSpider(this, EndPlayReason);
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
 
 void USpiderMovementComponent::TickComponent(float DeltaTime, ELevelTick TickType,
                                              FActorComponentTickFunction* ThisTickFunction)
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	// Probe and solve only, this may run on a worker thread so nothing here may move components
+	bHasPendingMove = false;
+	PendingBaseCarryDelta = FVector::ZeroVector;
+	PendingBaseCarryRotation = FQuat::Identity;
+	PendingBaseCarryFromTransform = FTransform::Identity;
+	PendingBaseCarryToTransform = FTransform::Identity;
+	PendingBaseCarryBase.Reset();
+	if (!UpdatedComponent)
+	{
+		return;
+	}
 	PerformMovement(DeltaTime);
 }
+
+void USpiderMovementComponent::ApplyPendingMovement(float DeltaTime, ELevelTick TickType)
+{
+	check(IsInGameThread());
+
+	bool bAppliedMove = false;
+	{
+		// Defer transform propagation and overlap updates so the velocity move, the surface move and the visual offset are flushed once
+		FScopedMovementUpdate ScopedMovementUpdate(UpdatedComponent, EScopedUpdate::DeferredUpdates);
+		const FTransform RootTransformBeforeMove = UpdatedComponent ? UpdatedComponent->GetComponentTransform() : FTransform::Identity;
+
+		// Ride along with the base before our own velocity move, so the base turns us about where we stood on it
+		if (UpdatedComponent && bHasPendingMove)
+		{
+			ApplyBaseCarry();
+		}
+
+		if (FallState.bIsFalling)
+		{
+			// The arc carries the launch velocity itself, FloatingPawnMovement would decelerate it and move it a second time.
+			// Input and direct moves have no say in the air, only impulses change the arc
+			UPawnMovementComponent::TickComponent(DeltaTime, TickType, &PrimaryComponentTick);
+			ConsumeInputVector();
+			Velocity = FallState.LaunchVelocity + PendingImpulse;
+			if (UpdatedComponent)
+			{
+				UpdatedComponent->ComponentVelocity = Velocity + FallState.Gravity * FallState.FallTime;
+			}
+		}
+		else
+		{
+			Super::TickComponent(DeltaTime, TickType, &PrimaryComponentTick);
+		}
+		PendingImpulse = FVector::ZeroVector;
+		if (UpdatedComponent && bHasPendingMove)
+		{
+			ApplyMovement(PendingMoveDelta, PendingMoveRotation);
+			TrackLandingSurface();
+			UpdateBaseTickPrerequisite();
+			bHasPendingMove = false;
+			bAppliedMove = true;
+		}
+		UpdateVisualRotation(DeltaTime, RootTransformBeforeMove);
+	}
+
+	// The physics volume is looked up from the overlaps, which are only current once the deferred scope has ended
+	if (bAppliedMove)
+	{
+		UpdatePhysicsVolumeIfNeeded();
+		UpdateSleepState(DeltaTime);
+	}
+	TakeProbeSnapshot();
+}
+
+void USpiderMovementComponent::TakeProbeSnapshot()
+{
+	// Impulses, direct moves and input written after this point reach the probe through the next apply phase
+	ProbeSnapshot.Velocity = Velocity;
+	ProbeSnapshot.InputVector = GetLastInputVector();
+}
+
+void USpiderMovementComponent::SetVisualComponent(USceneComponent* Visual, float RotationInterpSpeed)
+{
+	VisualComponent = Visual;
+	VisualRotationInterpSpeed = RotationInterpSpeed;
+	if (Visual)
+	{
+		VisualBaseRelativeRotation = Visual->GetRelativeRotation().Quaternion();
+		SmoothedVisualRotation = Visual->GetComponentQuat();
+	}
+}
+
+void USpiderMovementComponent::UpdateVisualRotation(float DeltaTime, const FTransform& RootTransformBeforeMove)
+{
+	USceneComponent* Visual = VisualComponent.Get();
+	if (!Visual || !UpdatedComponent || VisualRotationInterpSpeed <= 0.f)
+	{
+		return;
+	}
+
+	const FQuat RootRotation = UpdatedComponent->GetComponentQuat();
+	SmoothedVisualRotation = FMath::QInterpTo(SmoothedVisualRotation, RootRotation * VisualBaseRelativeRotation, DeltaTime, VisualRotationInterpSpeed);
+	const FQuat RelativeRotation = RootRotation.Inverse() * SmoothedVisualRotation;
+	if (Visual->GetRelativeRotation().Quaternion().Equals(RelativeRotation, UE_KINDA_SMALL_NUMBER))
+	{
+		return;
+	}
+
+	// A moved root propagates to its children when the deferred scope ends, the new relative rotation rides along with it.
+	// Only a root that stayed put needs the visual to propagate on its own
+	if (!RootTransformBeforeMove.Equals(UpdatedComponent->GetComponentTransform(), UE_SMALL_NUMBER))
+	{
+		Visual->SetRelativeRotation_Direct(RelativeRotation.Rotator());
+		return;
+	}
+	Visual->SetRelativeRotation(RelativeRotation);
+}
+
+void USpiderMovementComponent::AddInputVector(FVector WorldVector, bool bForce)
+{
+	if (!WorldVector.IsZero())
+	{
+		WakeUp();
+	}
+	Super::AddInputVector(WorldVector, bForce);
+}
+
+void USpiderMovementComponent::RequestDirectMove(const FVector& MoveVelocity, bool bForceMaxSpeed)
+{
+	if (!MoveVelocity.IsZero())
+	{
+		WakeUp();
+	}
+	Super::RequestDirectMove(MoveVelocity, bForceMaxSpeed);
+}
+
+void USpiderMovementComponent::RequestPathMove(const FVector& MoveInput)
+{
+	if (!MoveInput.IsZero())
+	{
+		WakeUp();
+	}
+	Super::RequestPathMove(MoveInput);
+}
+#pragma region Hibernation
+void USpiderMovementComponent::WriteHibernationRecord(FSpiderHibernationRecord& OutRecord) const
+{
+	const FVector Location = UpdatedComponent->GetComponentLocation();
+	const FVector SurfaceNormal = HotState.bHasGround ? HotState.GroundNormal.Unpack() : UpdatedComponent->GetUpVector();
+
+	// Anchor right below the spider, the ground probe itself is offset forward
+	OutRecord.SurfaceAnchor = HotState.bHasGround ? Location - SurfaceNormal * ((Location - HotState.GroundPoint) | SurfaceNormal) : Location;
+	OutRecord.SurfaceNormal.Pack(SurfaceNormal);
+	OutRecord.Rotation = UpdatedComponent->GetComponentQuat();
+	OutRecord.CoarseVelocity = FVector::VectorPlaneProject(Velocity, SurfaceNormal);
+	OutRecord.MaxCoarseTravel = HibernationMaxCoarseTravel;
+}
+
+void USpiderMovementComponent::EnterHibernation(FSpiderHibernationRecord& OutRecord)
+{
+	if (bIsHibernating || !UpdatedComponent)
+	{
+		return;
+	}
+
+	WriteHibernationRecord(OutRecord);
+	SetOwnerSuspended(true);
+	bIsHibernating = true;
+}
+
+void USpiderMovementComponent::ExitHibernation(const FSpiderHibernationRecord& Record)
+{
+	if (!UpdatedComponent)
+	{
+		return;
+	}
+
+	const FVector RecordNormal = Record.SurfaceNormal.Unpack();
+	const float LiftDistance = UpdatedPrimitive ? UpdatedPrimitive->GetCollisionShape().GetExtent().Z : 0.f;
+
+	// Single validation probe, without a surface the spider is placed at the anchor and falls from there
+	const FVector ProbeOffset = RecordNormal * (GroundTraceDistance + LiftDistance);
+	const FHitResult ValidationHit = DoLineTraceSingleByObject(Record.SurfaceAnchor + ProbeOffset, Record.SurfaceAnchor - ProbeOffset, bDrawDebug);
+	const FVector SurfaceNormal = ValidationHit.bBlockingHit ? FVector(ValidationHit.ImpactNormal) : RecordNormal;
+	const FVector SurfacePoint = ValidationHit.bBlockingHit ? FVector(ValidationHit.ImpactPoint) : Record.SurfaceAnchor;
+	const FQuat Rotation = FQuat::FindBetweenNormals(Record.Rotation.GetUpVector(), SurfaceNormal) * Record.Rotation;
+
+	UpdatedComponent->SetWorldLocationAndRotation(SurfacePoint + SurfaceNormal * LiftDistance, Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+	Velocity = Record.CoarseVelocity;
+	TakeProbeSnapshot();
+	RefreshPhysicsVolume();
+	bHasNearbyPhysicsVolumeBounds = false;
+	EndFall();
+	BaseContact = FSpiderBaseContact();
+
+	// The surface the spider slept on may be gone, it has to settle again
+	WakeUp();
+
+	if (bIsHibernating)
+	{
+		SetOwnerSuspended(false);
+		bIsHibernating = false;
+	}
+}
+
+void USpiderMovementComponent::SetOwnerSuspended(bool bSuspend)
+{
+	AActor* Owner = GetOwner();
+	if (!Owner)
+	{
+		return;
+	}
+
+	if (bSuspend)
+	{
+		// Only what actually ticks is remembered, so components disabled by design stay disabled on wake
+		ComponentsSuspendedByHibernation.Reset();
+		Owner->ForEachComponent(false, [this](UActorComponent* Component)
+		{
+			if (Component->IsComponentTickEnabled())
+			{
+				Component->SetComponentTickEnabled(false);
+				ComponentsSuspendedByHibernation.Add(Component);
+			}
+		});
+		bOwnerTickedBeforeHibernation = Owner->IsActorTickEnabled();
+		Owner->SetActorTickEnabled(false);
+
+		bOwnerWasHiddenBeforeHibernation = Owner->IsHidden();
+		bOwnerHadCollisionBeforeHibernation = Owner->GetActorEnableCollision();
+		Owner->SetActorHiddenInGame(true);
+		Owner->SetActorEnableCollision(false);
+		return;
+	}
+
+	for (const TWeakObjectPtr<UActorComponent>& Component : ComponentsSuspendedByHibernation)
+	{
+		if (Component.IsValid())
+		{
+			Component->SetComponentTickEnabled(true);
+		}
+	}
+	ComponentsSuspendedByHibernation.Reset();
+	Owner->SetActorTickEnabled(bOwnerTickedBeforeHibernation);
+	Owner->SetActorHiddenInGame(bOwnerWasHiddenBeforeHibernation);
+	Owner->SetActorEnableCollision(bOwnerHadCollisionBeforeHibernation);
+}
+#pragma endregion
+#pragma region Sleep
+void USpiderMovementComponent::AddImpulse(FVector Impulse)
+{
+	Velocity += Impulse;
+	PendingImpulse += Impulse;
+	WakeUp();
+}
+
+void USpiderMovementComponent::WakeUp()
+{
+	if (!bIsSleeping)
+	{
+		return;
+	}
+
+	UnbindWakeEvents();
+	bIsSleeping = false;
+	RestTime = 0.f;
+	DEC_DWORD_STAT(STAT_SpiderSleeping);
+
+	// The probe is not ticking while asleep, so whatever woke us can be handed to it right away
+	TakeProbeSnapshot();
+
+	// While hibernating the tick is given back when the hibernation ends
+	if (bIsHibernating)
+	{
+		ComponentsSuspendedByHibernation.Add(this);
+		return;
+	}
+	SetComponentTickEnabled(true);
+}
+
+void USpiderMovementComponent::UpdateSleepState(float DeltaTime)
+{
+	if (!bAllowSleep)
+	{
+		return;
+	}
+
+	// Resting means no input, no speed and a resting contact with the ground the spider already stood on.
+	// The contact is tested directly so sleep does not depend on bElideRedundantSweeps
+	const bool bIsResting = IsRestingOnGround() && !CanClimbToWall() && !FallState.bIsFalling
+		&& GetLastInputVector().IsNearlyZero() && Velocity.SizeSquared() <= FMath::Square(SleepVelocityThreshold);
+	const bool bIsSameSurface = HotState.GroundComponent == SleepBase
+		&& (HotState.GroundNormal.Unpack() | RestGroundNormal.Unpack()) >= 1.f - UE_KINDA_SMALL_NUMBER;
+
+	if (!bIsResting || !bIsSameSurface)
+	{
+		RestTime = 0.f;
+		SleepBase = HotState.GroundComponent;
+		RestGroundNormal = HotState.GroundNormal;
+		return;
+	}
+
+	RestTime += DeltaTime;
+	if (RestTime >= SleepRestTime)
+	{
+		Sleep();
+	}
+}
+
+void USpiderMovementComponent::Sleep()
+{
+	if (bIsSleeping)
+	{
+		return;
+	}
+
+	bIsSleeping = true;
+	Velocity = FVector::ZeroVector;
+	INC_DWORD_STAT(STAT_SpiderSleeping);
+	BindWakeEvents();
+	SetComponentTickEnabled(false);
+}
+
+void USpiderMovementComponent::BindWakeEvents()
+{
+	if (UPrimitiveComponent* Base = SleepBase.Get())
+	{
+		SleepBaseTransformUpdatedHandle = Base->TransformUpdated.AddUObject(this, &USpiderMovementComponent::OnBaseTransformUpdated);
+		// The physics state goes away when the base component alone is unregistered or destroyed
+		Base->OnComponentPhysicsStateChanged.AddUniqueDynamic(this, &USpiderMovementComponent::OnBasePhysicsStateChanged);
+		if (AActor* BaseActor = Base->GetOwner())
+		{
+			BaseActor->OnDestroyed.AddUniqueDynamic(this, &USpiderMovementComponent::OnBaseActorDestroyed);
+		}
+	}
+
+	if (AActor* Owner = GetOwner())
+	{
+		Owner->OnTakeAnyDamage.AddUniqueDynamic(this, &USpiderMovementComponent::OnOwnerTakeAnyDamage);
+	}
+
+	if (UpdatedPrimitive)
+	{
+		UpdatedPrimitive->OnComponentHit.AddUniqueDynamic(this, &USpiderMovementComponent::OnUpdatedComponentHit);
+	}
+}
+
+void USpiderMovementComponent::UnbindWakeEvents()
+{
+	if (UPrimitiveComponent* Base = SleepBase.Get())
+	{
+		Base->TransformUpdated.Remove(SleepBaseTransformUpdatedHandle);
+		Base->OnComponentPhysicsStateChanged.RemoveDynamic(this, &USpiderMovementComponent::OnBasePhysicsStateChanged);
+		if (AActor* BaseActor = Base->GetOwner())
+		{
+			BaseActor->OnDestroyed.RemoveDynamic(this, &USpiderMovementComponent::OnBaseActorDestroyed);
+		}
+	}
+	SleepBaseTransformUpdatedHandle.Reset();
+
+	if (AActor* Owner = GetOwner())
+	{
+		Owner->OnTakeAnyDamage.RemoveDynamic(this, &USpiderMovementComponent::OnOwnerTakeAnyDamage);
+	}
+
+	if (UpdatedPrimitive)
+	{
+		UpdatedPrimitive->OnComponentHit.RemoveDynamic(this, &USpiderMovementComponent::OnUpdatedComponentHit);
+	}
+}
+
+void USpiderMovementComponent::OnBaseTransformUpdated(USceneComponent* Component, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	WakeUp();
+}
+
+void USpiderMovementComponent::OnBaseActorDestroyed(AActor* DestroyedActor)
+{
+	WakeUp();
+}
+
+void USpiderMovementComponent::OnBasePhysicsStateChanged(UPrimitiveComponent* ChangedComponent, EComponentPhysicsStateChange StateChange)
+{
+	if (StateChange == EComponentPhysicsStateChange::Destroyed)
+	{
+		WakeUp();
+	}
+}
+
+void USpiderMovementComponent::OnOwnerTakeAnyDamage(AActor* DamagedActor, float Damage, const UDamageType* DamageType, AController* InstigatedBy, AActor* DamageCauser)
+{
+	WakeUp();
+}
+
+void USpiderMovementComponent::OnUpdatedComponentHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+{
+	WakeUp();
+}
+#pragma endregion
 #pragma region SpiderMovement
 
 TArray<FHitResult> USpiderMovementComponent::DoCapsuleTraceMultiByObject(const FVector& Start, const FVector& End, bool bShowDebugShape)
 {
+	INC_DWORD_STAT(STAT_SpiderSceneQueries);
 	TArray<FHitResult> OutHitResults;
 	// Use the capsule trace with Relative Orientation 
-	UTraceUtils::CapsuleTraceMultiForObjects(
-		this,
+	UTraceUtils::CapsuleTraceMultiForObjectsInWorld(
+		GetWorld(),
 		Start,
 		End,
 		SpiderCapsuleTraceRadius,
 		SpiderCapsuleTraceHalfHeight,
-		UpdatedComponent->GetComponentRotation(),
-		SpiderSurfaceTraceTypes,
-		false,
-		TArray<AActor*>(),
+		UpdatedComponent->GetComponentQuat(),
+		SurfaceObjectQueryParams,
+		SurfaceQueryParams,
 		bShowDebugShape? EDrawDebugTrace::ForOneFrame : EDrawDebugTrace::None,
-		OutHitResults,
-		false
+		OutHitResults
 		);
 	return OutHitResults;
 }
@@ -39,17 +601,16 @@ TArray<FHitResult> USpiderMovementComponent::DoCapsuleTraceMultiByObject(const F
 FHitResult USpiderMovementComponent::DoLineTraceSingleByObject(const FVector& Start, const FVector& End,
 	bool bShowDebugShape)
 {
+	INC_DWORD_STAT(STAT_SpiderSceneQueries);
 	FHitResult OutHitResult;
-	UKismetSystemLibrary::LineTraceSingleForObjects(
-	this,
+	UTraceUtils::LineTraceSingleForObjectsInWorld(
+		GetWorld(),
 		Start,
 		End,
-		SpiderSurfaceTraceTypes,
-		false,
-		TArray<AActor*>(),
+		SurfaceObjectQueryParams,
+		SurfaceQueryParams,
 		bShowDebugShape? EDrawDebugTrace::ForOneFrame : EDrawDebugTrace::None,
-		OutHitResult,
-		false
+		OutHitResult
 	);
 	return OutHitResult;
 }
@@ -60,11 +621,43 @@ void USpiderMovementComponent::PerformMovement(float DeltaTime)
 	FVector NewLocation;
 	FRotator NewRotation;
 
+	// While airborne and far from the predicted contact the arc is followed without probing
+	if (FallState.bIsFalling && !ShouldProbeWhileFalling(DeltaTime))
+	{
+		IntegrateFall(DeltaTime);
+		return;
+	}
+
+	// Ground is probed once per tick, the result is reused by the gravity check and by the sweep elision.
+	// Riding a base, the cached contact replaces the probe until the schedule or the base motion asks for a new one
+	const bool bReusedBaseContact = CarryAlongBase(DeltaTime);
+
+	// The apply phase moves by the velocity before the surface move, so the surfaces are probed where that move is about to take us
+	ProbeLocation = UpdatedComponent->GetComponentLocation() + PendingBaseCarryDelta + ProbeSnapshot.Velocity * DeltaTime;
+	if (!bReusedBaseContact)
+	{
+		HotState.bHasGround = TraceForCurrentGround();
+		CacheBaseContact();
+	}
+
+	// Walls and ceilings ahead, the probe cascade keeps this cheap while nothing is near
+	if (bProbeForWalls)
+	{
+		TraceForSurfaces();
+		ProcessSurfaceInfo();
+	}
+
+	if (HotState.bHasGround || CanClimbToWall())
+	{
+		EndFall();
+	}
+
 	// If a ground trace is successful pawn will continuously try to move towards the ground until collision hits
-	if (TraceForCurrentGround())
+	if (HotState.bHasGround)
 	{
-		NewRotation = GetRotationAlignedToSurface(GroundTraceResult.ImpactNormal);
-		NewLocation = GroundTraceResult.ImpactNormal  * -1.f * GravityFactor; 		
+		const FVector GroundNormal = HotState.GroundNormal.Unpack();
+		NewRotation = GetRotationAlignedToSurface(GroundNormal);
+		NewLocation = GroundNormal  * -1.f * GravityFactor; 		
 	}
 
 	// Check if the Pawn is near a wall then calculate Location and Rotation to move to that wall (Override Previous Location and Rotation)
@@ -74,90 +667,607 @@ void USpiderMovementComponent::PerformMovement(float DeltaTime)
 		ProcessSurfaceInfo();
 		
 		// Todo - @hamza Use Input Vector to decide Interpolation Alpha (Or not because I will be using it for AI?)
-		float ClimbAlpha = GetLastInputVector().Dot(UpdatedComponent->GetForwardVector());
-		NewRotation = GetRotationAlignedToSurface(CurrentSurfaceNormal);
-		NewLocation = CurrentSurfaceLocation * 0.1f;	
+		float ClimbAlpha = ProbeSnapshot.InputVector.Dot(UpdatedComponent->GetForwardVector());
+		NewRotation = GetRotationAlignedToSurface(HotState.SurfaceNormal.Unpack());
+		NewLocation = (HotState.SurfaceLocation - ProbeLocation) * 0.1f;
 		
 	}
 
-	// Check if the Pawn is not near wall nor near ground, apply gravity
-	if (!TraceForCurrentGround() && !CanClimbToWall())
+	// Check if the Pawn is not near wall nor near ground, fall along a ballistic arc
+	if (!HotState.bHasGround && !CanClimbToWall())
 	{
-		NewLocation = UpdatedComponent->GetUpVector() * -1.f * GravityFactor;
-		NewRotation = UpdatedComponent->GetComponentRotation();
+		if (!FallState.bIsFalling)
+		{
+			StartFall();
+		}
+		IntegrateFall(DeltaTime);
+		return;
 	}
 	
 	// Todo - @hamza Get Location using a function instead of hardcoded everywhere	
-	// Todo - @hamza Create A dedicated function for actual movement
-	// Move the component based on the calculated Location and Rotation
-	UpdatedComponent->MoveComponent(NewLocation, FQuat::Slerp(UpdatedComponent->GetComponentQuat(), NewRotation.Quaternion(), DeltaTime * 12.f), true);
+	// The move is applied on the game thread by ApplyPendingMovement
+	PendingMoveDelta = NewLocation;
+	PendingMoveRotation = PendingBaseCarryRotation * FQuat::Slerp(UpdatedComponent->GetComponentQuat(), NewRotation.Quaternion(), DeltaTime * 12.f);
+	bHasPendingMove = true;
+}
+
+void USpiderMovementComponent::ApplyMovement(const FVector& Delta, const FQuat& NewRotation)
+{
+	if (!CanSkipSweep(Delta))
+	{
+		INC_DWORD_STAT(STAT_SpiderSweepsPerformed);
+		FHitResult MoveHit;
+		UpdatedComponent->MoveComponent(Delta, NewRotation, true, &MoveHit);
+
+		// Anything on the arc, predicted or not, has the surfaces probed next tick. Only a probe that finds one ends the fall,
+		// a grazed ledge or wall keeps the arc going
+		if (FallState.bIsFalling && MoveHit.bBlockingHit)
+		{
+			FallState.bTouchedSurface = true;
+		}
+		return;
+	}
+
+	// The translation would be fully blocked by the ground we are resting on and a sphere does not collide differently
+	// when rotated, so only the rotation is applied and no scene query is needed
+	INC_DWORD_STAT(STAT_SpiderSweepsElided);
+	if (!UpdatedComponent->GetComponentQuat().Equals(NewRotation, UE_KINDA_SMALL_NUMBER))
+	{
+		UpdatedComponent->MoveComponent(FVector::ZeroVector, NewRotation, false);
+	}
+}
+
+bool USpiderMovementComponent::CanSkipSweep(const FVector& Delta) const
+{
+	if (!bElideRedundantSweeps || !HotState.bHasGround || CanClimbToWall())
+	{
+		return false;
+	}
+
+	// Only a sphere is rotation invariant, any other shape could start overlapping by rotating in place
+	if (!UpdatedPrimitive || !UpdatedPrimitive->GetCollisionShape().IsSphere())
+	{
+		return false;
+	}
+
+	// Moving away from or along the ground can reach geometry the probes did not cover
+	const FVector GroundNormal = HotState.GroundNormal.Unpack();
+	if ((Delta | GroundNormal) >= 0.f && !Delta.IsNearlyZero())
+	{
+		return false;
+	}
+
+	// Only a resting contact blocks the whole push
+	return IsRestingOnGround();
+}
+
+bool USpiderMovementComponent::IsRestingOnGround() const
+{
+	if (!HotState.bHasGround || !UpdatedPrimitive)
+	{
+		return false;
+	}
+
+	// Distance between the collision shape and the probed ground plane, shapes other than spheres are measured along their up extent
+	const FCollisionShape Shape = UpdatedPrimitive->GetCollisionShape();
+	const float ShapeExtent = Shape.IsSphere() ? Shape.GetSphereRadius() : Shape.GetExtent().Z;
+	const float GroundGap = ((UpdatedComponent->GetComponentLocation() - HotState.GroundPoint) | HotState.GroundNormal.Unpack()) - ShapeExtent;
+	return FMath::Abs(GroundGap) <= SweepElisionContactTolerance;
+}
+
+void USpiderMovementComponent::StartFall()
+{
+	FallState.bIsFalling = true;
+	FallState.FallTime = 0.f;
+	FallState.Gravity = UpdatedComponent->GetUpVector() * -1.f * FallGravityAcceleration;
+	FallState.LaunchVelocity = ProbeSnapshot.Velocity;
+	BaseContact = FSpiderBaseContact();
+	PredictLanding();
+}
+
+void USpiderMovementComponent::EndFall()
+{
+	FallState = FSpiderFallState();
+}
+
+bool USpiderMovementComponent::ShouldProbeWhileFalling(float DeltaTime)
+{
+	// Only an impulse changes the velocity in the air, the arc carries on from the new one
+	if (!ProbeSnapshot.Velocity.Equals(FallState.LaunchVelocity))
+	{
+		FallState.LaunchVelocity = ProbeSnapshot.Velocity;
+		PredictLanding();
+	}
+
+	if (FallState.bTouchedSurface)
+	{
+		FallState.bTouchedSurface = false;
+		return true;
+	}
+
+	const float NextFallTime = FallState.FallTime + DeltaTime;
+	if (NextFallTime < FallState.PredictedLandingTime - LandingProbeLeadTime)
+	{
+		// Far from the contact, only a moving landing surface invalidates the prediction
+		if (HasLandingSurfaceMoved())
+		{
+			PredictLanding();
+		}
+		return false;
+	}
+
+	// Close to the predicted contact the surface probes take over again
+	if (FallState.bHasPredictedLanding && NextFallTime <= FallState.PredictedLandingTime + LandingProbeLeadTime)
+	{
+		return true;
+	}
+
+	// Past the predicted arc or the contact without landing, predict the next stretch
+	PredictLanding();
+	return false;
+}
+
+void USpiderMovementComponent::IntegrateFall(float DeltaTime)
+{
+	const float PreviousFallTime = FallState.FallTime;
+	FallState.FallTime += DeltaTime;
+
+	// Displacement of the arc between both fall times, the floating pawn tick does not move the spider while it falls
+	HotState.bHasGround = false;
+	PendingMoveDelta = FallState.LaunchVelocity * DeltaTime
+		+ FallState.Gravity * 0.5f * (FMath::Square(FallState.FallTime) - FMath::Square(PreviousFallTime));
+	PendingMoveRotation = UpdatedComponent->GetComponentQuat();
+	bHasPendingMove = true;
+}
+
+void USpiderMovementComponent::PredictLanding()
+{
+	INC_DWORD_STAT(STAT_SpiderLandingPredictions);
+
+	const UWorld* World = GetWorld();
+	const FCollisionShape Shape = UpdatedPrimitive ? UpdatedPrimitive->GetCollisionShape() : FCollisionShape::MakeSphere(0.f);
+	const FVector Start = UpdatedComponent->GetComponentLocation();
+	const FVector StartVelocity = FallState.LaunchVelocity + FallState.Gravity * FallState.FallTime;
+	const float SegmentTime = LandingPredictionTime / LandingPredictionSegments;
+
+	FallState.bHasPredictedLanding = false;
+	FallState.bLandingSurfaceMoved = false;
+	FallState.bHasLandingComponentTransform = false;
+	FallState.PredictedLandingTime = FallState.FallTime + LandingPredictionTime;
+	FallState.LandingComponent.Reset();
+
+	// Straight sweeps along the arc, only done when the fall starts or the landing surface moves
+	FVector SegmentStart = Start;
+	for (int32 Segment = 1; Segment <= LandingPredictionSegments && World; ++Segment)
+	{
+		const float Time = SegmentTime * Segment;
+		const FVector SegmentEnd = Start + StartVelocity * Time + FallState.Gravity * 0.5f * FMath::Square(Time);
+
+		INC_DWORD_STAT(STAT_SpiderSceneQueries);
+		FHitResult Hit;
+		if (World->SweepSingleByObjectType(Hit, SegmentStart, SegmentEnd, UpdatedComponent->GetComponentQuat(), SurfaceObjectQueryParams, Shape, SurfaceQueryParams))
+		{
+			FallState.bHasPredictedLanding = true;
+			FallState.PredictedLandingTime = FallState.FallTime + SegmentTime * (Segment - 1 + Hit.Time);
+			FallState.LandingComponent = Hit.GetComponent();
+			return;
+		}
+		SegmentStart = SegmentEnd;
+	}
+}
+
+bool USpiderMovementComponent::HasLandingSurfaceMoved() const
+{
+	// The transform itself is compared by TrackLandingSurface on the game thread, a vanished surface needs a new prediction too
+	return FallState.bLandingSurfaceMoved || (FallState.bHasPredictedLanding && !FallState.LandingComponent.IsValid());
+}
+
+void USpiderMovementComponent::TrackLandingSurface()
+{
+	// Movable components may be moved by ticks running alongside the probe phase, so their transform is only read here.
+	// The first read after a prediction is the reference, the probe phase picks a change up on the next tick
+	const UPrimitiveComponent* LandingComponent = FallState.LandingComponent.Get();
+	if (!FallState.bIsFalling || !LandingComponent || LandingComponent->Mobility != EComponentMobility::Movable)
+	{
+		return;
+	}
+
+	const FTransform& LandingComponentTransform = LandingComponent->GetComponentTransform();
+	if (FallState.bHasLandingComponentTransform && !LandingComponentTransform.Equals(FallState.LandingComponentTransform))
+	{
+		FallState.bLandingSurfaceMoved = true;
+	}
+	FallState.LandingComponentTransform = LandingComponentTransform;
+	FallState.bHasLandingComponentTransform = true;
+}
+
+bool USpiderMovementComponent::CarryAlongBase(float DeltaTime)
+{
+	const UPrimitiveComponent* Base = BaseContact.Base.Get();
+	if (!Base)
+	{
+		return false;
+	}
+
+	// Keep our transform relative to the base as it was last tick
+	const FTransform BaseTransform = Base->GetComponentTransform();
+	const FTransform LastBaseTransform = BaseContact.LastBaseTransform;
+	const FVector Location = UpdatedComponent->GetComponentLocation();
+	PendingBaseCarryDelta = BaseTransform.TransformPosition(LastBaseTransform.InverseTransformPosition(Location)) - Location;
+	PendingBaseCarryRotation = BaseTransform.GetRotation() * LastBaseTransform.GetRotation().Inverse();
+	PendingBaseCarryFromTransform = LastBaseTransform;
+	PendingBaseCarryToTransform = BaseTransform;
+	PendingBaseCarryBase = BaseContact.Base;
+	BaseContact.LastBaseTransform = BaseTransform;
+	BaseContact.TimeSinceProbe += DeltaTime;
+
+	// A jump of the base, a new scale or our own motion on it can all invalidate the contact
+	const bool bBaseJumped = PendingBaseCarryRotation.GetAngle() > FMath::DegreesToRadians(BaseReprobeAngle)
+		|| PendingBaseCarryDelta.SizeSquared() > FMath::Square(BaseReprobeDistance)
+		|| !BaseTransform.GetScale3D().Equals(LastBaseTransform.GetScale3D());
+	const bool bMovingOnBase = !ProbeSnapshot.InputVector.IsNearlyZero() || ProbeSnapshot.Velocity.SizeSquared() > FMath::Square(SleepVelocityThreshold);
+	if (bBaseJumped || bMovingOnBase || BaseContact.TimeSinceProbe >= BaseReprobeInterval)
+	{
+		return false;
+	}
+
+	INC_DWORD_STAT(STAT_SpiderBaseContactReuses);
+	HotState.bHasGround = true;
+	HotState.GroundPoint = BaseTransform.TransformPosition(BaseContact.LocalPoint);
+	HotState.GroundNormal.Pack(BaseTransform.TransformVectorNoScale(BaseContact.LocalNormal));
+	return true;
+}
+
+void USpiderMovementComponent::ApplyBaseCarry()
+{
+	if (PendingBaseCarryDelta.IsZero() && PendingBaseCarryRotation.IsIdentity())
+	{
+		return;
+	}
+
+	// The root may have moved since the probe, carry it from where it stands now
+	const FVector Location = UpdatedComponent->GetComponentLocation();
+	const FVector CarryDelta = PendingBaseCarryToTransform.TransformPosition(PendingBaseCarryFromTransform.InverseTransformPosition(Location)) - Location;
+
+	// Only the base itself is ignored, a wall or ceiling the base carries us into still blocks,
+	// the spider is then left behind and the next probe finds where it stands
+	UPrimitiveComponent* Base = PendingBaseCarryBase.Get();
+	const bool bIgnoreBase = Base && UpdatedPrimitive && !UpdatedPrimitive->GetMoveIgnoreComponents().Contains(Base);
+	if (bIgnoreBase)
+	{
+		UpdatedPrimitive->IgnoreComponentWhenMoving(Base, true);
+	}
+
+	INC_DWORD_STAT(STAT_SpiderSweepsPerformed);
+	FHitResult CarryHit;
+	UpdatedComponent->MoveComponent(CarryDelta, PendingBaseCarryRotation * UpdatedComponent->GetComponentQuat(), true, &CarryHit);
+
+	if (bIgnoreBase)
+	{
+		UpdatedPrimitive->IgnoreComponentWhenMoving(Base, false);
+	}
+
+	// Left behind, the cached contact no longer matches where the spider is on the base
+	if (CarryHit.bBlockingHit)
+	{
+		BaseContact.TimeSinceProbe = BaseReprobeInterval;
+	}
+}
+
+void USpiderMovementComponent::CacheBaseContact()
+{
+	UPrimitiveComponent* Base = HotState.GroundComponent.Get();
+	if (!HotState.bHasGround || !Base)
+	{
+		BaseContact = FSpiderBaseContact();
+		return;
+	}
+
+	const FTransform BaseTransform = Base->GetComponentTransform();
+	BaseContact.Base = Base;
+	BaseContact.LastBaseTransform = BaseTransform;
+	BaseContact.LocalPoint = BaseTransform.InverseTransformPosition(HotState.GroundPoint);
+	BaseContact.LocalNormal = BaseTransform.InverseTransformVectorNoScale(HotState.GroundNormal.Unpack());
+	BaseContact.TimeSinceProbe = 0.f;
+}
+
+void USpiderMovementComponent::UpdateBaseTickPrerequisite()
+{
+	// Reading a base transform while the base moves would race, so the probe of a spider on a movable base waits for it.
+	// Prerequisites can only be changed on the game thread
+	UPrimitiveComponent* Base = BaseContact.Base.Get();
+	if (!Base || Base->Mobility != EComponentMobility::Movable || Base->GetOwner() == GetOwner())
+	{
+		Base = nullptr;
+	}
+	if (Base == TickPrerequisiteBase.Get())
+	{
+		return;
+	}
+
+	if (AActor* PreviousBaseActor = TickPrerequisiteBaseActor.Get())
+	{
+		RemoveTickPrerequisiteActor(PreviousBaseActor);
+	}
+	for (const TWeakObjectPtr<UActorComponent>& PreviousComponent : TickPrerequisiteBaseComponents)
+	{
+		if (PreviousComponent.IsValid())
+		{
+			RemoveTickPrerequisiteComponent(PreviousComponent.Get());
+		}
+	}
+	TickPrerequisiteBaseActor.Reset();
+	TickPrerequisiteBaseComponents.Reset();
+	TickPrerequisiteBase = Base;
+
+	AActor* BaseActor = Base ? Base->GetOwner() : nullptr;
+	if (!BaseActor)
+	{
+		return;
+	}
+
+	// The base can be moved by its actor tick, its own component tick or a movement component updating it or one of its parents.
+	// Simulated bases are written by the physics sync, which does not overlap the pre physics probe
+	TickPrerequisiteBaseActor = BaseActor;
+	AddTickPrerequisiteActor(BaseActor);
+	TickPrerequisiteBaseComponents.Add(Base);
+	AddTickPrerequisiteComponent(Base);
+	BaseActor->ForEachComponent<UMovementComponent>(false, [this, Base](UMovementComponent* MovementComponent)
+	{
+		const USceneComponent* MovedComponent = MovementComponent->UpdatedComponent;
+		if (MovedComponent && (MovedComponent == Base || Base->IsAttachedTo(MovedComponent)))
+		{
+			TickPrerequisiteBaseComponents.Add(MovementComponent);
+			AddTickPrerequisiteComponent(MovementComponent);
+		}
+	});
 }
 
 bool USpiderMovementComponent::TraceForSurfaces()
 {
+	// Cascade from cheapest to most expensive, the capsule sweep only runs when something is close enough to be hit by it
+	// Walking on open ground is the case the cheap stages are for, it is counted apart so a regression shows up on its own
+	const bool bIsWalking = HotState.bHasGround && ProbeSnapshot.Velocity.SizeSquared() > FMath::Square(SleepVelocityThreshold);
+	if (!CVarSpiderProbeForceCapsuleSweep.GetValueOnAnyThread())
+	{
+		const bool bCachedOpenSpace = IsInCachedOpenSpace();
+		OpenSpaceCache.FramesLeft = FMath::Max(OpenSpaceCache.FramesLeft - 1, 0);
+		if (bCachedOpenSpace || IsSurfaceProbeVolumeEmpty())
+		{
+			if (bCachedOpenSpace)
+			{
+				INC_DWORD_STAT(STAT_SpiderCascadeCached);
+			}
+			else
+			{
+				INC_DWORD_STAT(STAT_SpiderCascadeOverlapClear);
+			}
+			if (bIsWalking)
+			{
+				INC_DWORD_STAT(STAT_SpiderCascadeWalkingCheap);
+			}
+			SurfaceComponents.Reset();
+			HotState.SurfaceHitCount = 0;
+			HotState.SurfaceLocation = FVector::ZeroVector;
+			HotState.SurfaceNormal = FSpiderPackedNormal();
+			if (DebugHitResults)
+			{
+				DebugHitResults->SpiderSurfaceTracedResults.Reset();
+			}
+			return false;
+		}
+	}
+	INC_DWORD_STAT(STAT_SpiderCascadeCapsuleSweep);
+	if (bIsWalking)
+	{
+		INC_DWORD_STAT(STAT_SpiderCascadeWalkingSweep);
+	}
+
 	const FVector Offset = UpdatedComponent->GetForwardVector() * WallTraceStartOffset;
-	const FVector Start = UpdatedComponent->GetComponentLocation() + Offset;
+	const FVector Start = ProbeLocation + Offset;
 	const FVector End = Start + UpdatedComponent->GetForwardVector();
 
-	SpiderSurfaceTracedResults = DoCapsuleTraceMultiByObject(Start, End, bDrawDebug);
-	return !SpiderSurfaceTracedResults.IsEmpty();
+	const TArray<FHitResult> SpiderSurfaceTracedResults = DoCapsuleTraceMultiByObject(Start, End, bDrawDebug);
+
+	// Only the averaged contact and the touched components are kept
+	FVector SurfaceLocation = FVector::ZeroVector;
+	FVector SurfaceNormal = FVector::ZeroVector;
+	SurfaceComponents.Reset();
+	for (const FHitResult& Hit : SpiderSurfaceTracedResults)
+	{
+		SurfaceLocation += Hit.ImpactPoint;
+		SurfaceNormal += Hit.ImpactNormal;
+		SurfaceComponents.AddUnique(Hit.GetComponent());
+	}
+
+	HotState.SurfaceHitCount = static_cast<uint8>(FMath::Min(SpiderSurfaceTracedResults.Num(), static_cast<int32>(MAX_uint8)));
+	HotState.SurfaceLocation = SpiderSurfaceTracedResults.IsEmpty() ? FVector::ZeroVector : SurfaceLocation / SpiderSurfaceTracedResults.Num();
+	HotState.SurfaceNormal.Pack(SurfaceNormal.GetSafeNormal());
+
+	if (bKeepFullHitResults)
+	{
+		if (!DebugHitResults)
+		{
+			DebugHitResults = MakeUnique<FSpiderDebugHitResults>();
+		}
+		DebugHitResults->SpiderSurfaceTracedResults = SpiderSurfaceTracedResults;
+	}
+	return HotState.SurfaceHitCount > 0;
+}
+
+bool USpiderMovementComponent::IsInCachedOpenSpace() const
+{
+	if (OpenSpaceCache.FramesLeft <= 0)
+	{
+		return false;
+	}
+
+	const FVector LocalOffset = OpenSpaceCache.Rotation.UnrotateVector(ProbeLocation - OpenSpaceCache.Location);
+	return FVector2D(LocalOffset.X, LocalOffset.Y).SizeSquared() <= FMath::Square(OpenSpaceCache.PlanarMargin)
+		&& FMath::Abs(LocalOffset.Z) <= OpenSpaceCache.NormalMargin;
+}
+
+bool USpiderMovementComponent::IsSurfaceProbeVolumeEmpty()
+{
+	// The probe is inflated by the distance the spider covers in a few frames, so an empty result can be reused meanwhile.
+	// Along the surface and off it separately, a walking spider must not inflate the probe into the ground it walks on
+	const UWorld* World = GetWorld();
+	const float DeltaSeconds = World ? World->GetDeltaSeconds() : 0.f;
+	const float CacheSeconds = DeltaSeconds * OpenSpaceCacheFrames;
+	const FQuat Rotation = UpdatedComponent->GetComponentQuat();
+	const FVector Up = Rotation.GetUpVector();
+	const FVector TotalVelocity = ProbeSnapshot.Velocity + FallState.Gravity * FallState.FallTime;
+	const float PlanarMargin = FMath::Min(FVector::VectorPlaneProject(TotalVelocity, Up).Size() * CacheSeconds, OpenSpaceCacheMaxMargin);
+	const float NormalMargin = FMath::Min(FMath::Abs(TotalVelocity | Up) * CacheSeconds, OpenSpaceCacheMaxMargin);
+	const float BoundingRadius = GetSurfaceProbeBoundingRadius();
+	const FVector Location = ProbeLocation;
+
+	INC_DWORD_STAT(STAT_SpiderSceneQueries);
+	const bool bIsEmpty = World && !World->OverlapAnyTestByObjectType(Location, Rotation, SurfaceObjectQueryParams,
+		FCollisionShape::MakeBox(FVector(BoundingRadius + PlanarMargin, BoundingRadius + PlanarMargin, BoundingRadius + NormalMargin)), SurfaceQueryParams);
+	if (bIsEmpty)
+	{
+		OpenSpaceCache.Location = Location;
+		OpenSpaceCache.Rotation = Rotation;
+		OpenSpaceCache.PlanarMargin = PlanarMargin;
+		OpenSpaceCache.NormalMargin = NormalMargin;
+		OpenSpaceCache.FramesLeft = OpenSpaceCacheFrames;
+	}
+	return bIsEmpty;
+}
+
+float USpiderMovementComponent::GetSurfaceProbeBoundingRadius() const
+{
+	// Farthest point of the capsule sweep from the spider, whatever the spider's orientation:
+	// the capsule axis ends are offset forward by WallTraceStartOffset and up or down by HalfHeight - Radius, and the sweep is one unit long
+	const float AxisHalfLength = FMath::Max(SpiderCapsuleTraceHalfHeight - SpiderCapsuleTraceRadius, 0.f);
+	return FMath::Sqrt(FMath::Square(WallTraceStartOffset) + FMath::Square(AxisHalfLength)) + SpiderCapsuleTraceRadius + 1.f;
 }
 
 bool USpiderMovementComponent::TraceForCurrentGround()
 {
 	const FVector FwdOffset = (UpdatedComponent->GetForwardVector() * GroundTraceForwardOffset);
 	const FVector UpOffset = (UpdatedComponent->GetUpVector() * GroundTraceDistance);
-	FVector Start = UpdatedComponent->GetComponentLocation() + FwdOffset;
+	// Probe where the base and the velocity move are about to take us
+	const FVector Location = ProbeLocation;
+	FVector Start = Location + FwdOffset;
 	Start += UpOffset;
-	FVector End = UpdatedComponent->GetComponentLocation() + FwdOffset;
+	FVector End = Location + FwdOffset;
 	End -= UpOffset;
 
-	GroundTraceResult =  DoLineTraceSingleByObject(Start, End, bDrawDebug);
+	const FHitResult GroundTraceResult =  DoLineTraceSingleByObject(Start, End, bDrawDebug);
+	HotState.GroundPoint = GroundTraceResult.ImpactPoint;
+	HotState.GroundNormal.Pack(GroundTraceResult.ImpactNormal);
+	HotState.GroundComponent = GroundTraceResult.GetComponent();
+
+	if (bKeepFullHitResults)
+	{
+		if (!DebugHitResults)
+		{
+			DebugHitResults = MakeUnique<FSpiderDebugHitResults>();
+		}
+		DebugHitResults->GroundTraceResult = GroundTraceResult;
+	}
 	return GroundTraceResult.bBlockingHit;
 }
 
 void USpiderMovementComponent::ProcessSurfaceInfo()
 {
-	CurrentSurfaceLocation = FVector::ZeroVector;
-	CurrentSurfaceNormal = FVector::ZeroVector;
-	if (SpiderSurfaceTracedResults.IsEmpty())
+	// Location and normal are already averaged by TraceForSurfaces
+	HotState.bWantToClimbWall = HotState.SurfaceHitCount > 0;
+}
+
+FRotator USpiderMovementComponent::GetRotationAlignedToSurface(FVector SurfaceNormal)
+{
+	const FVector newUp = SurfaceNormal;
+	const FVector newForward = newUp.Cross(UpdatedComponent->GetForwardVector().Cross(UpdatedComponent->GetUpVector()));
+	const FVector newRight = newUp.Cross(newForward);
+
+	return UKismetMathLibrary::MakeRotationFromAxes(newForward, newRight, newUp);
+}
+
+void USpiderMovementComponent::UpdatePhysicsVolumeIfNeeded()
+{
+	const FVector Location = UpdatedComponent->GetComponentLocation();
+	const bool bTravelledFar = !bHasNearbyPhysicsVolumeBounds
+		|| FVector::DistSquared(Location, LastPhysicsVolumeUpdateLocation) >= FMath::Square(PhysicsVolumeRecheckDistance);
+
+	// Entering or leaving any nearby volume, however small, changes the volume before the travel distance is reached
+	if (!bTravelledFar && GetNearbyPhysicsVolumeMask(Location) == NearbyPhysicsVolumeMask)
 	{
-		bWantToClimbWall = false;
 		return;
 	}
-	CurrentSurfaceLocation = FVector::ZeroVector;
-	CurrentSurfaceNormal = FVector::ZeroVector;
 
-	for (const FHitResult Hit : SpiderSurfaceTracedResults)
+	RefreshPhysicsVolume();
+	if (bTravelledFar)
 	{
-		CurrentSurfaceLocation += Hit.ImpactPoint;
-		CurrentSurfaceNormal += Hit.ImpactNormal;
+		CacheNearbyPhysicsVolumeBounds(Location);
 	}
+	NearbyPhysicsVolumeMask = GetNearbyPhysicsVolumeMask(Location);
+}
 
-	CurrentSurfaceLocation /= SpiderSurfaceTracedResults.Num();
-	CurrentSurfaceNormal = CurrentSurfaceNormal.GetSafeNormal();
-	bWantToClimbWall = true;
+void USpiderMovementComponent::RefreshPhysicsVolume()
+{
+	// UpdatePhysicsVolume returns early while the root opts out of per move refreshes, the opt out is lifted for this one refresh only
+	UpdatedComponent->SetShouldUpdatePhysicsVolume(true);
+	UpdatedComponent->UpdatePhysicsVolume(true);
+	UpdatedComponent->SetShouldUpdatePhysicsVolume(false);
+	LastPhysicsVolumeUpdateLocation = UpdatedComponent->GetComponentLocation();
 }
 
-FRotator USpiderMovementComponent::GetRotationAlignedToSurface(FVector SurfaceNormal)
+void USpiderMovementComponent::CacheNearbyPhysicsVolumeBounds(const FVector& Location)
 {
-	const FVector newUp = SurfaceNormal;
-	const FVector newForward = newUp.Cross(UpdatedComponent->GetForwardVector().Cross(UpdatedComponent->GetUpVector()));
-	const FVector newRight = newUp.Cross(newForward);
+	NearbyPhysicsVolumeBounds.Reset();
+	bHasNearbyPhysicsVolumeBounds = true;
+	const UWorld* World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
 
-	return UKismetMathLibrary::MakeRotationFromAxes(newForward, newRight, newUp);
+	// Only volumes the spider can reach before the next refresh, the default volume has no bounds and is what remains outside of them.
+	// Each tracked volume takes one bit of NearbyPhysicsVolumeMask
+	constexpr int32 MaxTrackedVolumes = 32;
+	const FSphere ReachableSphere(Location, PhysicsVolumeRecheckDistance + UpdatedComponent->Bounds.SphereRadius);
+	for (auto VolumeIter = World->GetNonDefaultPhysicsVolumeIterator(); VolumeIter && NearbyPhysicsVolumeBounds.Num() < MaxTrackedVolumes; ++VolumeIter)
+	{
+		const APhysicsVolume* Volume = VolumeIter->Get();
+		if (!Volume)
+		{
+			continue;
+		}
+
+		const FBox VolumeBounds = Volume->GetComponentsBoundingBox();
+		if (VolumeBounds.IsValid && FMath::SphereAABBIntersection(ReachableSphere, VolumeBounds))
+		{
+			NearbyPhysicsVolumeBounds.Add(VolumeBounds);
+		}
+	}
+}
+
+uint32 USpiderMovementComponent::GetNearbyPhysicsVolumeMask(const FVector& Location) const
+{
+	uint32 Mask = 0;
+	for (int32 Index = 0; Index < NearbyPhysicsVolumeBounds.Num(); ++Index)
+	{
+		if (NearbyPhysicsVolumeBounds[Index].IsInside(Location))
+		{
+			Mask |= 1u << Index;
+		}
+	}
+	return Mask;
 }
 
 bool USpiderMovementComponent::CanClimbToWall() const
 {
-	return bWantToClimbWall;
+	return HotState.bWantToClimbWall;
 }
 
 bool USpiderMovementComponent::DoesComponentExistInTracedSurfaces(const USceneComponent* ComponentToCheck)
 {
-	for (FHitResult Hit : SpiderSurfaceTracedResults)
+	for (const TWeakObjectPtr<UPrimitiveComponent>& SurfaceComponent : SurfaceComponents)
 	{
-		if (Hit.GetComponent() == ComponentToCheck)
+		if (SurfaceComponent.Get() == ComponentToCheck)
 		{
 			return true;
 		}
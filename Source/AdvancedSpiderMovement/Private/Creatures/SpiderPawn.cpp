@@ -10,6 +10,57 @@
 #include "Camera/CameraComponent.h"
 #include "Components/SphereComponent.h"
 #include "GameFramework/SpringArmComponent.h"
+#include "EngineUtils.h"
+#include "Serialization/ArchiveCountMem.h"
+#include "UObject/UObjectHash.h"
+
+namespace SpiderPawnMemory
+{
+	/** Instance size plus everything the object owns that the engine can see (containers, resources) */
+	static SIZE_T GetObjectMemory(UObject* Object)
+	{
+		FArchiveCountMem CountMem(Object);
+		return Object->GetClass()->GetStructureSize() + CountMem.GetMax() + Object->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+	}
+
+	static void Report(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		SIZE_T TotalBytes = 0;
+		int32 SpiderCount = 0;
+		for (TActorIterator<ASpiderPawn> It(World); It; ++It)
+		{
+			ASpiderPawn* Spider = *It;
+			const SIZE_T PawnBytes = GetObjectMemory(Spider);
+			const SIZE_T MovementBytes = Spider->GetSpiderMovementComponent() ? GetObjectMemory(Spider->GetSpiderMovementComponent()) : 0;
+
+			SIZE_T SubobjectBytes = 0;
+			int32 SubobjectCount = 0;
+			TArray<UObject*> Subobjects;
+			GetObjectsWithOuter(Spider, Subobjects, true);
+			for (UObject* Subobject : Subobjects)
+			{
+				if (Subobject != Spider->GetSpiderMovementComponent())
+				{
+					SubobjectBytes += GetObjectMemory(Subobject);
+					++SubobjectCount;
+				}
+			}
+
+			const SIZE_T SpiderBytes = PawnBytes + MovementBytes + SubobjectBytes;
+			Ar.Logf(TEXT("%s: Pawn %.2f KB, Movement %.2f KB, Subobjects (%d) %.2f KB, Total %.2f KB"),
+				*Spider->GetName(), PawnBytes / 1024.f, MovementBytes / 1024.f, SubobjectCount, SubobjectBytes / 1024.f, SpiderBytes / 1024.f);
+
+			TotalBytes += SpiderBytes;
+			++SpiderCount;
+		}
+		Ar.Logf(TEXT("%d spiders, Total %.2f KB"), SpiderCount, TotalBytes / 1024.f);
+	}
+
+	static FAutoConsoleCommandWithWorldArgsAndOutputDevice ReportCommand(
+		TEXT("Spider.MemReport"),
+		TEXT("Reports per spider and total memory of the spider pawns, their movement components and subobjects"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&Report));
+}
 
 // Sets default values
 ASpiderPawn::ASpiderPawn()
@@ -64,11 +115,6 @@ ASpiderPawn::ASpiderPawn()
 	// Note: The skeletal mesh and anim blueprint references on the Mesh component (inherited from Character) 
 	// are set in the derived blueprint asset named ThirdPersonCharacter (to avoid direct content references in C++)
 
-	MeshBoom = CreateDefaultSubobject<USpringArmComponent>(TEXT("MeshBoom"));
-	MeshBoom->SetupAttachment(RootComponent);
-	MeshBoom->TargetArmLength = 0.f; // The camera follows at this distance behind the character	
-	MeshBoom->bUsePawnControlRotation = false; // Rotate the arm based on the controller
-	
 	Mesh = CreateOptionalDefaultSubobject<USkeletalMeshComponent>(FName("Mesh"));
 	if (Mesh)
 	{
@@ -79,7 +125,7 @@ ASpiderPawn::ASpiderPawn()
 		Mesh->bCastDynamicShadow = true;
 		Mesh->bAffectDynamicIndirectLighting = true;
 		Mesh->PrimaryComponentTick.TickGroup = TG_PrePhysics;
-		Mesh->SetupAttachment(MeshBoom);
+		Mesh->SetupAttachment(RootComponent);
 		static FName MeshCollisionProfileName(TEXT("CharacterMesh"));
 		Mesh->SetCollisionProfileName(MeshCollisionProfileName);
 		Mesh->SetGenerateOverlapEvents(false);
@@ -99,7 +145,16 @@ void ASpiderPawn::BeginPlay()
 			Subsystem->AddMappingContext(DefaultMappingContext, 0);
 		}
 	}
-	
+
+	// Camera and mesh follow the spider once per frame, after the game thread apply phase has moved it
+	if (SpiderMovementComponent)
+	{
+		PrimaryActorTick.AddPrerequisite(SpiderMovementComponent, SpiderMovementComponent->GetApplyTickFunction());
+		CameraBoom->PrimaryComponentTick.AddPrerequisite(SpiderMovementComponent, SpiderMovementComponent->GetApplyTickFunction());
+
+		// The mesh eases towards the root inside the movement apply phase
+		SpiderMovementComponent->SetVisualComponent(Mesh, MeshRotationInterpSpeed);
+	}
 }
 
 #pragma region InputFunctions
@@ -0,0 +1,163 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Subsystems/SpiderHibernationSubsystem.h"
+#include "GameFramework/PlayerController.h"
+
+static TAutoConsoleVariable<float> CVarSpiderHibernationCheckInterval(
+	TEXT("Spider.Hibernation.CheckInterval"),
+	0.5f,
+	TEXT("Seconds between checks of spider distances to the player views."));
+
+static TAutoConsoleVariable<float> CVarSpiderHibernationCoarseStep(
+	TEXT("Spider.Hibernation.CoarseStep"),
+	1.f,
+	TEXT("Seconds between steps of the coarse timeline hibernating spiders advance on."));
+
+static TAutoConsoleVariable<float> CVarSpiderHibernationWakeRatio(
+	TEXT("Spider.Hibernation.WakeRatio"),
+	0.9f,
+	TEXT("Fraction of the hibernation distance a spider has to come back within to wake, avoids toggling at the threshold."));
+
+bool USpiderHibernationSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USpiderHibernationSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TimeSinceHibernationCheck += DeltaTime;
+	if (TimeSinceHibernationCheck >= CVarSpiderHibernationCheckInterval.GetValueOnGameThread())
+	{
+		TimeSinceHibernationCheck = 0.f;
+		UpdateHibernationStates();
+	}
+
+	TimeSinceCoarseStep += DeltaTime;
+	if (TimeSinceCoarseStep >= CVarSpiderHibernationCoarseStep.GetValueOnGameThread())
+	{
+		AdvanceCoarseTimeline(TimeSinceCoarseStep);
+		TimeSinceCoarseStep = 0.f;
+	}
+}
+
+TStatId USpiderHibernationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USpiderHibernationSubsystem, STATGROUP_Tickables);
+}
+
+void USpiderHibernationSubsystem::RegisterSpider(USpiderMovementComponent* Spider)
+{
+	Spiders.AddUnique(Spider);
+
+	// The cell of this spider streamed back in, continue where the coarse timeline left it
+	FSpiderHibernationRecord Record;
+	if (Records.RemoveAndCopyValue(GetSpiderKey(Spider), Record))
+	{
+		Spider->ExitHibernation(Record);
+	}
+}
+
+void USpiderHibernationSubsystem::UnregisterSpider(USpiderMovementComponent* Spider, EEndPlayReason::Type EndPlayReason)
+{
+	Spiders.Remove(Spider);
+
+	const FSoftObjectPath Key = GetSpiderKey(Spider);
+	if (EndPlayReason != EEndPlayReason::RemovedFromWorld)
+	{
+		Records.Remove(Key);
+		return;
+	}
+
+	// Streamed out, a spider already hibernating has an up to date record
+	FSpiderHibernationRecord& Record = Records.FindOrAdd(Key);
+	if (!Spider->IsHibernating())
+	{
+		Spider->WriteHibernationRecord(Record);
+	}
+}
+
+void USpiderHibernationSubsystem::UpdateHibernationStates()
+{
+	TArray<FVector> ViewLocations;
+	GatherViewLocations(ViewLocations);
+	if (ViewLocations.IsEmpty())
+	{
+		return;
+	}
+
+	const float WakeRatio = CVarSpiderHibernationWakeRatio.GetValueOnGameThread();
+	for (int32 Index = Spiders.Num() - 1; Index >= 0; --Index)
+	{
+		USpiderMovementComponent* Spider = Spiders[Index].Get();
+		if (!Spider || !Spider->UpdatedComponent)
+		{
+			Spiders.RemoveAtSwap(Index);
+			continue;
+		}
+
+		// A hibernating spider is frozen in place while its record drifts along the coarse timeline, the record is where it will wake
+		const FSoftObjectPath Key = GetSpiderKey(Spider);
+		const FSpiderHibernationRecord* HibernationRecord = Spider->IsHibernating() ? Records.Find(Key) : nullptr;
+		const FVector SpiderLocation = HibernationRecord ? HibernationRecord->SurfaceAnchor : Spider->UpdatedComponent->GetComponentLocation();
+		double MinDistanceSquared = TNumericLimits<double>::Max();
+		for (const FVector& ViewLocation : ViewLocations)
+		{
+			MinDistanceSquared = FMath::Min(MinDistanceSquared, FVector::DistSquared(SpiderLocation, ViewLocation));
+		}
+
+		const float HibernationDistance = Spider->GetHibernationDistance();
+		if (!Spider->IsHibernating() && Spider->CanHibernate() && MinDistanceSquared > FMath::Square(HibernationDistance))
+		{
+			Spider->EnterHibernation(Records.FindOrAdd(Key));
+		}
+		else if (Spider->IsHibernating() && MinDistanceSquared < FMath::Square(HibernationDistance * WakeRatio))
+		{
+			FSpiderHibernationRecord Record;
+			if (Records.RemoveAndCopyValue(Key, Record))
+			{
+				Spider->ExitHibernation(Record);
+			}
+		}
+	}
+}
+
+void USpiderHibernationSubsystem::AdvanceCoarseTimeline(float DeltaTime)
+{
+	// Slide along the surface plane the spider hibernated on, the validation probe on wake snaps it back to real geometry
+	for (TPair<FSoftObjectPath, FSpiderHibernationRecord>& Pair : Records)
+	{
+		FSpiderHibernationRecord& Record = Pair.Value;
+		const float RemainingTravel = Record.MaxCoarseTravel - Record.CoarseTravelDistance;
+		if (RemainingTravel <= 0.f || Record.CoarseVelocity.IsNearlyZero())
+		{
+			continue;
+		}
+
+		const float Travel = FMath::Min(Record.CoarseVelocity.Size() * DeltaTime, RemainingTravel);
+		Record.SurfaceAnchor += Record.CoarseVelocity.GetSafeNormal() * Travel;
+		Record.CoarseTravelDistance += Travel;
+	}
+}
+
+void USpiderHibernationSubsystem::GatherViewLocations(TArray<FVector>& OutViewLocations) const
+{
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APlayerController* PlayerController = It->Get())
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+			OutViewLocations.Add(ViewLocation);
+		}
+	}
+}
+
+FSoftObjectPath USpiderHibernationSubsystem::GetSpiderKey(const USpiderMovementComponent* Spider)
+{
+	// Placed actors keep their path when their cell streams out and back in
+	return FSoftObjectPath(Spider->GetOwner());
+}
@@ -5,6 +5,7 @@
 #include <Engine/EngineTypes.h>
 #include "PhysicsEngine/PhysicsSettings.h"
 #include "DrawDebugHelpers.h"
+#include "KismetTraceUtils.h"
 
 static const float KISMET_TRACE_DEBUG_IMPACTPOINT_SIZE = 16.f;
 
@@ -82,6 +83,41 @@ bool UTraceUtils::CapsuleTraceMultiByProfile(UObject* WorldContextObject, const
 	return bHit;
 }
 
+bool UTraceUtils::CapsuleTraceMultiForObjectsInWorld(const UWorld* World, const FVector& Start, const FVector& End, float Radius, float HalfHeight, const FQuat& Orientation, const FCollisionObjectQueryParams& ObjectParams, const FCollisionQueryParams& Params, EDrawDebugTrace::Type DrawDebugType, TArray<FHitResult>& OutHits, FLinearColor TraceColor, FLinearColor TraceHitColor, float DrawTime)
+{
+	bool const bHit = World && ObjectParams.IsValid() ? World->SweepMultiByObjectType(OutHits, Start, End, Orientation, ObjectParams, FCollisionShape::MakeCapsule(Radius, HalfHeight), Params) : false;
+
+#if ENABLE_DRAW_DEBUG
+	// Debug drawing is not thread safe
+	if (IsInGameThread())
+	{
+		DrawDebugCapsuleTraceMulti(World, Start, End, Radius, HalfHeight, Orientation.Rotator(), DrawDebugType, bHit, OutHits, TraceColor, TraceHitColor, DrawTime);
+	}
+#endif
+
+	return bHit;
+}
+
+bool UTraceUtils::LineTraceSingleForObjectsInWorld(const UWorld* World, const FVector& Start, const FVector& End, const FCollisionObjectQueryParams& ObjectParams, const FCollisionQueryParams& Params, EDrawDebugTrace::Type DrawDebugType, FHitResult& OutHit, FLinearColor TraceColor, FLinearColor TraceHitColor, float DrawTime)
+{
+	bool const bHit = World && ObjectParams.IsValid() ? World->LineTraceSingleByObjectType(OutHit, Start, End, ObjectParams, Params) : false;
+
+#if ENABLE_DRAW_DEBUG
+	// Debug drawing is not thread safe
+	if (IsInGameThread())
+	{
+		DrawDebugLineTraceSingle(World, Start, End, DrawDebugType, bHit, OutHit, TraceColor, TraceHitColor, DrawTime);
+	}
+#endif
+
+	return bHit;
+}
+
+FCollisionObjectQueryParams UTraceUtils::MakeObjectQueryParams(const TArray<TEnumAsByte<EObjectTypeQuery> > & ObjectTypes)
+{
+	return ConfigureCollisionObjectParams(ObjectTypes);
+}
+
 FCollisionQueryParams UTraceUtils::ConfigureCollisionParams(FName TraceTag, bool bTraceComplex, const TArray<AActor*>& ActorsToIgnore, bool bIgnoreSelf, UObject* WorldContextObject)
 {
 	FCollisionQueryParams Params(TraceTag, SCENE_QUERY_STAT_ONLY(KismetTraceUtils), bTraceComplex);
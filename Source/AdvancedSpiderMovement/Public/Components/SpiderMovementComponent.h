@@ -6,6 +6,106 @@
 #include "GameFramework/FloatingPawnMovement.h"
 #include "SpiderMovementComponent.generated.h"
 
+struct FSpiderHibernationRecord;
+
+/** Unit normal stored with 16 bits per axis, precise enough for surface alignment */
+struct FSpiderPackedNormal
+{
+	int16 X = 0;
+	int16 Y = 0;
+	int16 Z = 0;
+
+	void Pack(const FVector& Normal);
+	FVector Unpack() const;
+};
+
+/** Surface data movement reads every tick, ground contact first so the common path stays in one cache line */
+struct alignas(PLATFORM_CACHE_LINE_SIZE) FSpiderMovementHotState
+{
+	FVector GroundPoint = FVector::ZeroVector;
+	TWeakObjectPtr<UPrimitiveComponent> GroundComponent;
+	FSpiderPackedNormal GroundNormal;
+	FSpiderPackedNormal SurfaceNormal;
+	uint8 SurfaceHitCount = 0;
+	bool bHasGround = false;
+	bool bWantToClimbWall = false;
+	FVector SurfaceLocation = FVector::ZeroVector;
+};
+
+/** Airborne state, the arc is integrated analytically from the fall start so it does not depend on frame rate */
+struct FSpiderFallState
+{
+	bool bIsFalling = false;
+	bool bHasPredictedLanding = false;
+	bool bTouchedSurface = false;
+	bool bLandingSurfaceMoved = false;
+	bool bHasLandingComponentTransform = false;
+	float FallTime = 0.f;
+	float PredictedLandingTime = 0.f;
+	FVector Gravity = FVector::ZeroVector;
+	FVector LaunchVelocity = FVector::ZeroVector;
+	TWeakObjectPtr<UPrimitiveComponent> LandingComponent;
+	FTransform LandingComponentTransform;
+};
+
+/** Ground contact cached in the base's local space, so the spider can ride a moving base without re-tracing it */
+struct FSpiderBaseContact
+{
+	TWeakObjectPtr<UPrimitiveComponent> Base;
+	FTransform LastBaseTransform;
+	FVector LocalPoint = FVector::ZeroVector;
+	FVector LocalNormal = FVector::UpVector;
+	float TimeSinceProbe = 0.f;
+};
+
+/** Last cheap probe that found nothing around the spider, trusted while the spider stays within its margins along and off the surface */
+struct FSpiderOpenSpaceCache
+{
+	FVector Location = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+	float PlanarMargin = 0.f;
+	float NormalMargin = 0.f;
+	int32 FramesLeft = 0;
+};
+
+/** Game thread state the probe phase works from, taken at the end of each apply phase so a worker never reads members the game thread may write */
+struct FSpiderProbeSnapshot
+{
+	FVector Velocity = FVector::ZeroVector;
+	FVector InputVector = FVector::ZeroVector;
+};
+
+/** Full trace results, only allocated while debugging asks for them */
+struct FSpiderDebugHitResults
+{
+	TArray<FHitResult> SpiderSurfaceTracedResults;
+	FHitResult GroundTraceResult;
+};
+
+class USpiderMovementComponent;
+
+/** Game thread tick applying the move solved by the (possibly worker thread) component tick */
+USTRUCT()
+struct FSpiderMovementApplyTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	USpiderMovementComponent* Target = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+	virtual FName DiagnosticContext(bool bDetailed) override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FSpiderMovementApplyTickFunction> : public TStructOpsTypeTraitsBase2<FSpiderMovementApplyTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
 /**
  * 
  */
@@ -14,8 +114,64 @@ class ADVANCEDSPIDERMOVEMENT_API USpiderMovementComponent : public UFloatingPawn
 {
 	GENERATED_BODY()
 
+public:
+	USpiderMovementComponent();
+
+	virtual void SetUpdatedComponent(USceneComponent* NewUpdatedComponent) override;
+	virtual void SetComponentTickEnabled(bool bEnabled) override;
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+	/** Runs the game thread only apply phase, anything following the spider should tick after it */
+	void ApplyPendingMovement(float DeltaTime, ELevelTick TickType);
+	FTickFunction& GetApplyTickFunction() { return ApplyTickFunction; }
+
+	/** Eases Visual towards the root rotation inside the apply phase, so it is moved by the same transform propagation as the root */
+	void SetVisualComponent(USceneComponent* Visual, float RotationInterpSpeed);
+
+	/** Wakes a sleeping spider before passing the input on */
+	virtual void AddInputVector(FVector WorldVector, bool bForce = false) override;
+
+	/** AI path following moves through these instead of AddInputVector, they wake a sleeping spider too */
+	virtual void RequestDirectMove(const FVector& MoveVelocity, bool bForceMaxSpeed) override;
+	virtual void RequestPathMove(const FVector& MoveInput) override;
+
+	/** Component the spider stands on and is carried along with, null while airborne */
+	UFUNCTION(BlueprintPure, Category = "AdvancedSpiderMovement | Movement")
+	UPrimitiveComponent* GetMovementBase() const { return BaseContact.Base.Get(); }
+
+#pragma region Sleep
+	/** Adds to the velocity and wakes the spider */
+	UFUNCTION(BlueprintCallable, Category = "AdvancedSpiderMovement | Sleep")
+	void AddImpulse(FVector Impulse);
+
+	/** Resumes ticking and probing, does nothing if the spider is awake */
+	UFUNCTION(BlueprintCallable, Category = "AdvancedSpiderMovement | Sleep")
+	void WakeUp();
+
+	UFUNCTION(BlueprintPure, Category = "AdvancedSpiderMovement | Sleep")
+	bool IsSleeping() const { return bIsSleeping; }
+#pragma endregion
+
+#pragma region Hibernation
+	bool CanHibernate() const { return bAllowHibernation; }
+	float GetHibernationDistance() const { return HibernationDistance; }
+	bool IsHibernating() const { return bIsHibernating; }
+
+	/** Captures the compact state the spider can be restored from */
+	void WriteHibernationRecord(FSpiderHibernationRecord& OutRecord) const;
+
+	/** Captures the compact state, then stops ticking, hides the spider and disables its collision */
+	void EnterHibernation(FSpiderHibernationRecord& OutRecord);
+
+	/** Re-materializes the spider from a record with a single validation probe */
+	void ExitHibernation(const FSpiderHibernationRecord& Record);
+#pragma endregion
+
 protected:
 #pragma region OverriddenFunctions
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void RegisterComponentTickFunctions(bool bRegister) override;
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 #pragma endregion 
 
@@ -26,22 +182,105 @@ private:
 #pragma endregion 
 #pragma region SpiderMovementCore
 	virtual void PerformMovement(float DeltaTime);
+	void ApplyMovement(const FVector& Delta, const FQuat& NewRotation);
+
+	void StartFall();
+	void EndFall();
+	bool ShouldProbeWhileFalling(float DeltaTime);
+	void IntegrateFall(float DeltaTime);
+	void PredictLanding();
+	bool HasLandingSurfaceMoved() const;
+	void TrackLandingSurface();
+
+	bool CarryAlongBase(float DeltaTime);
+	void ApplyBaseCarry();
+	void CacheBaseContact();
+	void UpdateBaseTickPrerequisite();
+	bool CanSkipSweep(const FVector& Delta) const;
+	void TakeProbeSnapshot();
+	bool IsRestingOnGround() const;
 	
 	bool TraceForSurfaces();
+	bool IsInCachedOpenSpace() const;
+	bool IsSurfaceProbeVolumeEmpty();
+	float GetSurfaceProbeBoundingRadius() const;
 	bool TraceForCurrentGround();
 	bool CanClimbToWall() const;
 	bool DoesComponentExistInTracedSurfaces(const USceneComponent* ComponentToCheck);
 	void ProcessSurfaceInfo();
 
 	FRotator GetRotationAlignedToSurface(FVector SurfaceNormal);
+	void UpdatePhysicsVolumeIfNeeded();
+	void RefreshPhysicsVolume();
+	void UpdateVisualRotation(float DeltaTime, const FTransform& RootTransformBeforeMove);
+	void CacheNearbyPhysicsVolumeBounds(const FVector& Location);
+	uint32 GetNearbyPhysicsVolumeMask(const FVector& Location) const;
+	void SetOwnerSuspended(bool bSuspend);
+#pragma endregion
+#pragma region Sleep
+	void UpdateSleepState(float DeltaTime);
+	void Sleep();
+	void BindWakeEvents();
+	void UnbindWakeEvents();
+	void OnBaseTransformUpdated(USceneComponent* Component, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	UFUNCTION()
+	void OnBaseActorDestroyed(AActor* DestroyedActor);
+
+	UFUNCTION()
+	void OnBasePhysicsStateChanged(UPrimitiveComponent* ChangedComponent, EComponentPhysicsStateChange StateChange);
+
+	UFUNCTION()
+	void OnOwnerTakeAnyDamage(AActor* DamagedActor, float Damage, const UDamageType* DamageType, AController* InstigatedBy, AActor* DamageCauser);
+
+	UFUNCTION()
+	void OnUpdatedComponentHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
 #pragma endregion
 #pragma region SpiderMovementCoreVars
-	TArray<FHitResult> SpiderSurfaceTracedResults;
-	FHitResult GroundTraceResult;
-	FVector CurrentSurfaceLocation;
-	FVector CurrentSurfaceNormal;
-	bool bWantToClimbWall;
+	FSpiderMovementHotState HotState;
+	FSpiderFallState FallState;
+	FSpiderBaseContact BaseContact;
+	FSpiderOpenSpaceCache OpenSpaceCache;
+	FSpiderProbeSnapshot ProbeSnapshot;
+	FVector PendingImpulse = FVector::ZeroVector;
+	FVector ProbeLocation = FVector::ZeroVector;
+	TWeakObjectPtr<UPrimitiveComponent> TickPrerequisiteBase;
+	TWeakObjectPtr<AActor> TickPrerequisiteBaseActor;
+	TArray<TWeakObjectPtr<UActorComponent>, TInlineAllocator<2>> TickPrerequisiteBaseComponents;
+	FVector PendingBaseCarryDelta = FVector::ZeroVector;
+	FQuat PendingBaseCarryRotation = FQuat::Identity;
+	FTransform PendingBaseCarryFromTransform = FTransform::Identity;
+	FTransform PendingBaseCarryToTransform = FTransform::Identity;
+	TWeakObjectPtr<UPrimitiveComponent> PendingBaseCarryBase;
+	TArray<TWeakObjectPtr<UPrimitiveComponent>, TInlineAllocator<4>> SurfaceComponents;
+	TUniquePtr<FSpiderDebugHitResults> DebugHitResults;
+	FCollisionObjectQueryParams SurfaceObjectQueryParams;
+	FCollisionQueryParams SurfaceQueryParams;
+	FVector PendingMoveDelta;
+	FQuat PendingMoveRotation;
+	bool bHasPendingMove = false;
+
+	UPROPERTY()
+	FSpiderMovementApplyTickFunction ApplyTickFunction;
 	bool bLockRotation;
+	FVector LastPhysicsVolumeUpdateLocation;
+	TArray<FBox, TInlineAllocator<4>> NearbyPhysicsVolumeBounds;
+	uint32 NearbyPhysicsVolumeMask = 0;
+	bool bHasNearbyPhysicsVolumeBounds = false;
+	bool bIsHibernating = false;
+	bool bOwnerTickedBeforeHibernation = true;
+	bool bOwnerWasHiddenBeforeHibernation = false;
+	bool bOwnerHadCollisionBeforeHibernation = true;
+	TArray<TWeakObjectPtr<UActorComponent>> ComponentsSuspendedByHibernation;
+	bool bIsSleeping = false;
+	float RestTime = 0.f;
+	FSpiderPackedNormal RestGroundNormal;
+	TWeakObjectPtr<USceneComponent> VisualComponent;
+	FQuat VisualBaseRelativeRotation = FQuat::Identity;
+	FQuat SmoothedVisualRotation = FQuat::Identity;
+	float VisualRotationInterpSpeed = 0.f;
+	TWeakObjectPtr<UPrimitiveComponent> SleepBase;
+	FDelegateHandle SleepBaseTransformUpdatedHandle;
 #pragma endregion 
 #pragma region SpiderMovementBPVars
 	
@@ -56,6 +295,10 @@ private:
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Movement", meta = (AllowPrivateAccess = "true"))
 	float WallTraceStartOffset = 30.f;
+
+	/** Probe for walls and ceilings ahead every tick and climb onto them, off keeps the spider on the ground below it */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Movement", meta = (AllowPrivateAccess = "true"))
+	bool bProbeForWalls = false;
 	
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Movement", meta = (AllowPrivateAccess = "true"))
 	float GroundTraceForwardOffset = 30.f;
@@ -66,8 +309,88 @@ private:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Physics", meta = (AllowPrivateAccess = "true"))
 	float GravityFactor = 3.f;
 
+	/** Acceleration applied along the spider's down vector while airborne */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Physics", meta = (AllowPrivateAccess = "true", ClampMin = "0.0"))
+	float FallGravityAcceleration = 1960.f;
+
+	/** How far ahead, in seconds, the landing point is predicted when a fall starts */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Physics", meta = (AllowPrivateAccess = "true", ClampMin = "0.01"))
+	float LandingPredictionTime = 2.f;
+
+	/** Number of straight sweeps approximating the predicted arc */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Physics", meta = (AllowPrivateAccess = "true", ClampMin = "1", ClampMax = "32"))
+	int32 LandingPredictionSegments = 6;
+
+	/** Surface probing resumes this many seconds before the predicted contact */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Physics", meta = (AllowPrivateAccess = "true", ClampMin = "0.0"))
+	float LandingProbeLeadTime = 0.1f;
+
+	/** Skip the swept move when the ground probe already proves the updated sphere is resting on the surface it is pushed into */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Optimization", meta = (AllowPrivateAccess = "true"))
+	bool bElideRedundantSweeps = true;
+
+	/** Max distance between the updated component and the probed ground plane for the spider to count as in contact, for sweep elision and sleep */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Optimization", meta = (AllowPrivateAccess = "true", ClampMin = "0.0"))
+	float SweepElisionContactTolerance = 1.f;
+
+	/** Refresh the physics volume only after entering or leaving the bounds of a nearby volume or travelling this far, instead of on every move */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Optimization", meta = (AllowPrivateAccess = "true", ClampMin = "0.0"))
+	float PhysicsVolumeRecheckDistance = 200.f;
+
+	/** Let the hibernation subsystem suspend this spider when it is far from every player or its cell streams out */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Hibernation", meta = (AllowPrivateAccess = "true"))
+	bool bAllowHibernation = true;
+
+	/** Distance from the closest player view beyond which the spider hibernates */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Hibernation", meta = (AllowPrivateAccess = "true", ClampMin = "0.0", EditCondition = "bAllowHibernation"))
+	float HibernationDistance = 10000.f;
+
+	/** How far a hibernating spider may drift along its surface on the coarse timeline */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Hibernation", meta = (AllowPrivateAccess = "true", ClampMin = "0.0", EditCondition = "bAllowHibernation"))
+	float HibernationMaxCoarseTravel = 2000.f;
+
+	/** Frames of travel at the current speed an empty surface probe stays trusted, 0 checks every frame */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Optimization", meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	int32 OpenSpaceCacheFrames = 4;
+
+	/** Upper bound of the extra radius probed for the open space cache */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Optimization", meta = (AllowPrivateAccess = "true", ClampMin = "0.0"))
+	float OpenSpaceCacheMaxMargin = 100.f;
+
+	/** Seconds a cached base contact is trusted before the ground is probed again */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Optimization", meta = (AllowPrivateAccess = "true", ClampMin = "0.0"))
+	float BaseReprobeInterval = 0.25f;
+
+	/** Base rotation in a single tick, in degrees, beyond which the cached contact is probed again */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Optimization", meta = (AllowPrivateAccess = "true", ClampMin = "0.0"))
+	float BaseReprobeAngle = 5.f;
+
+	/** Base travel in a single tick beyond which the cached contact is probed again */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Optimization", meta = (AllowPrivateAccess = "true", ClampMin = "0.0"))
+	float BaseReprobeDistance = 50.f;
+
+	/** Stop ticking and probing after resting on a stable surface without input, wakes on input, damage, impulse, hits and base motion */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Sleep", meta = (AllowPrivateAccess = "true"))
+	bool bAllowSleep = true;
+
+	/** Seconds of rest before falling asleep */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Sleep", meta = (AllowPrivateAccess = "true", ClampMin = "0.0", EditCondition = "bAllowSleep"))
+	float SleepRestTime = 2.f;
+
+	/** Speed below which the spider counts as resting */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Sleep", meta = (AllowPrivateAccess = "true", ClampMin = "0.0", EditCondition = "bAllowSleep"))
+	float SleepVelocityThreshold = 1.f;
+
+	/** Run the probe and solve phase on a worker thread, the move itself is always applied on the game thread. Ignored while drawing debug */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Optimization", meta = (AllowPrivateAccess = "true"))
+	bool bTickProbeOnAnyThread = true;
+
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Debug", meta = (AllowPrivateAccess = "true"))
 	bool bDrawDebug = false;
+
+	/** Keep the full hit results of the last ground and surface traces for inspection, costs several hundred bytes per spider */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Debug", meta = (AllowPrivateAccess = "true"))
+	bool bKeepFullHitResults = false;
 	
 	
 #pragma endregion 
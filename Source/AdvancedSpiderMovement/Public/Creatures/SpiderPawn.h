@@ -41,7 +41,7 @@ protected:
 	/** Called for looking input */
 	void Look(const FInputActionValue& Value);
 #pragma endregion
-	
+
 private:
 #pragma region Components
 	/** Camera boom positioning the camera behind the character */
@@ -58,9 +58,6 @@ private:
 	UPROPERTY(Category=Collision, VisibleAnywhere, BlueprintReadOnly, meta=(AllowPrivateAccess = "true"))
 	TObjectPtr<USphereComponent> SphereComponent;
 
-	UPROPERTY(Category=Collision, VisibleAnywhere, BlueprintReadOnly, meta=(AllowPrivateAccess = "true"))
-	TObjectPtr<USpringArmComponent> MeshBoom;
-	
 	UPROPERTY(Category=Character, VisibleAnywhere, BlueprintReadOnly, meta=(AllowPrivateAccess = "true"))
 	TObjectPtr<USkeletalMeshComponent> Mesh;
 #pragma endregion
@@ -77,6 +74,11 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
 	class UInputAction* LookAction;
 #pragma endregion
+#pragma region MeshVisuals
+	/** How fast the mesh catches up with the root rotation, 0 keeps the mesh rigidly attached */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AdvancedSpiderMovement | Mesh", meta = (AllowPrivateAccess = "true", ClampMin = "0.0"))
+	float MeshRotationInterpSpeed = 0.f;
+#pragma endregion
 #pragma region Getters|Setters
 public:
 	FORCEINLINE class USpringArmComponent* GetCameraBoom() const { return CameraBoom; }
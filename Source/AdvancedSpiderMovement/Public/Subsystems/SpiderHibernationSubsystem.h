@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Components/SpiderMovementComponent.h"
+#include "SpiderHibernationSubsystem.generated.h"
+
+/** Compact state a hibernating spider is reduced to, slid along a straight line on its surface plane on a coarse timeline without physics */
+struct FSpiderHibernationRecord
+{
+	FVector SurfaceAnchor = FVector::ZeroVector;
+	FSpiderPackedNormal SurfaceNormal;
+	FQuat Rotation = FQuat::Identity;
+	FVector CoarseVelocity = FVector::ZeroVector;
+	/** Distance slid so far, the slide stops at MaxCoarseTravel */
+	float CoarseTravelDistance = 0.f;
+	float MaxCoarseTravel = 0.f;
+};
+
+/**
+ * Keeps far away and streamed out spiders persistent at near zero cost.
+ * Spiders beyond their HibernationDistance from every player view are reduced to a FSpiderHibernationRecord and stop ticking,
+ * spiders whose cell streams out leave their record behind and pick it up again when the cell streams back in.
+ */
+UCLASS()
+class ADVANCEDSPIDERMOVEMENT_API USpiderHibernationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Called by spiders entering play, restores the state left behind if the spider streamed out earlier */
+	void RegisterSpider(USpiderMovementComponent* Spider);
+
+	/** Called by spiders leaving play, keeps their state when they are only streamed out */
+	void UnregisterSpider(USpiderMovementComponent* Spider, EEndPlayReason::Type EndPlayReason);
+
+	int32 GetNumHibernatingSpiders() const { return Records.Num(); }
+
+private:
+	void UpdateHibernationStates();
+	void AdvanceCoarseTimeline(float DeltaTime);
+	void GatherViewLocations(TArray<FVector>& OutViewLocations) const;
+
+	static FSoftObjectPath GetSpiderKey(const USpiderMovementComponent* Spider);
+
+	/** Spiders that are in the world, hibernating or not */
+	TArray<TWeakObjectPtr<USpiderMovementComponent>> Spiders;
+
+	/** States of hibernating spiders, keyed by the path of their owning actor so they survive streaming */
+	TMap<FSoftObjectPath, FSpiderHibernationRecord> Records;
+
+	float TimeSinceHibernationCheck = 0.f;
+	float TimeSinceCoarseStep = 0.f;
+};
@@ -86,6 +86,40 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Collision", meta = (bIgnoreSelf = "true", WorldContext = "WorldContextObject", AutoCreateRefTerm = "ActorsToIgnore", DisplayName = "MultiCapsuleTraceByProfile", AdvancedDisplay = "TraceColor,TraceHitColor,DrawTime", Keywords = "sweep"))
 		static bool CapsuleTraceMultiByProfile(UObject* WorldContextObject, const FVector Start, const FVector End, float Radius, float HalfHeight, FRotator Orientation, FName ProfileName, bool bTraceComplex, const TArray<AActor*>& ActorsToIgnore, EDrawDebugTrace::Type DrawDebugType, TArray<FHitResult>& OutHits, bool bIgnoreSelf, FLinearColor TraceColor = FLinearColor::Red, FLinearColor TraceHitColor = FLinearColor::Green, float DrawTime = 5.0f);
 
+	/**
+	 * Sweeps a capsule against the given world and returns all hits encountered, with prebuilt query params.
+	 * Does not resolve the world from a context object and only draws debug shapes on the game thread,
+	 * so it is safe to call from a component ticking on a worker thread.
+	 *
+	 * @param World			World to trace in
+	 * @param Start			Start of line segment.
+	 * @param End			End of line segment.
+	 * @param Radius		Radius of the capsule to sweep
+	 * @param HalfHeight	Distance from center of capsule to tip of hemisphere endcap.
+	 * @param ObjectParams	Object types to trace, see MakeObjectQueryParams
+	 * @param Params		Query params, build them once and reuse them
+	 * @param OutHits		A list of hits, sorted along the trace from start to finish.
+	 * @return				True if there was a hit, false otherwise.
+	 */
+	static bool CapsuleTraceMultiForObjectsInWorld(const UWorld* World, const FVector& Start, const FVector& End, float Radius, float HalfHeight, const FQuat& Orientation, const FCollisionObjectQueryParams& ObjectParams, const FCollisionQueryParams& Params, EDrawDebugTrace::Type DrawDebugType, TArray<FHitResult>& OutHits, FLinearColor TraceColor = FLinearColor::Red, FLinearColor TraceHitColor = FLinearColor::Green, float DrawTime = 5.0f);
+
+	/**
+	 * Does a line trace against the given world and returns the first blocking hit, with prebuilt query params.
+	 * Safe to call from a worker thread, see CapsuleTraceMultiForObjectsInWorld.
+	 *
+	 * @param World			World to trace in
+	 * @param Start			Start of line segment.
+	 * @param End			End of line segment.
+	 * @param ObjectParams	Object types to trace, see MakeObjectQueryParams
+	 * @param Params		Query params, build them once and reuse them
+	 * @param OutHit		Properties of the trace hit.
+	 * @return				True if there was a hit, false otherwise.
+	 */
+	static bool LineTraceSingleForObjectsInWorld(const UWorld* World, const FVector& Start, const FVector& End, const FCollisionObjectQueryParams& ObjectParams, const FCollisionQueryParams& Params, EDrawDebugTrace::Type DrawDebugType, FHitResult& OutHit, FLinearColor TraceColor = FLinearColor::Red, FLinearColor TraceHitColor = FLinearColor::Green, float DrawTime = 5.0f);
+
+	/** Converts object types to query params once, so traces running every tick do not have to */
+	static FCollisionObjectQueryParams MakeObjectQueryParams(const TArray<TEnumAsByte<EObjectTypeQuery> > & ObjectTypes);
+
 protected:
 
 	static inline FCollisionQueryParams ConfigureCollisionParams(FName TraceTag, bool bTraceComplex, const TArray<AActor*>& ActorsToIgnore, bool bIgnoreSelf, UObject* WorldContextObject);